@@ -104,4 +104,11 @@ typedef enum Move {
     NONE,
     MOVE,
     CAPTURE
-} Move;
\ No newline at end of file
+} Move;
+
+// Replay
+#define KEYFRAME_INTERVAL 16 // plies between full snapshots, so seeking applies at most this many deltas
+#define REPLAY_BAR_HEIGHT 20
+#define REPLAY_BAR_Y (SIDEBAR_Y + SIDEBAR_HEIGHT - PADDING - REPLAY_BAR_HEIGHT)
+#define REPLAY_BAR_WIDTH (SIDEBAR_WIDTH - PADDING * 2)
+#define REPLAY_MAX_SPEED 512 // plies per second
@@ -0,0 +1,129 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "defs.h"
+#include "game.h"
+#include "evaluate.h"
+
+static const char * featureNames[FEATURE_COUNT] = {
+    "sides_3",
+    "sides_4",
+    "sides_5",
+    "sides_6",
+    "mobility",
+    "near_stone",
+    "near_lava",
+    "score_difference"
+};
+
+// Features
+
+// 1 when on a cell of that type, 1/2 next to one, 1/3 two away and so on. 0 if there are none
+float proximity(Ruleset ruleset, int cell, CellType cellType) {
+    int nearest = CELLS;
+    for (int c = 0; c < TOTAL_CELLS; c++) {
+        if (ruleset.cellTypes[c] != cellType) continue;
+        
+        // Pieces can move diagonally, so count steps as a king would
+        int dx = abs(c % CELLS - cell % CELLS);
+        int dy = abs(c / CELLS - cell / CELLS);
+        int distance = dx > dy ? dx : dy;
+        if (distance < nearest) nearest = distance;
+    }
+    
+    return nearest == CELLS ? 0.0f : 1.0f / (nearest + 1);
+}
+
+void extractFeatures(Ruleset ruleset, Piece pieces[TOTAL_CELLS], int score[2], float features[FEATURE_COUNT]) {
+    memset(features, 0, FEATURE_COUNT * sizeof(float));
+    
+    for (int cell = 0; cell < TOTAL_CELLS; cell++) {
+        Piece piece = pieces[cell];
+        if (!piece.present) continue;
+        
+        float sign = piece.player == 0 ? 1.0f : -1.0f;
+        PieceDef pieceDef = ruleset.pieceDefs[piece.pieceDef];
+        
+        features[SIDES_3 + pieceDef.sides - 3] += sign;
+        int moves[TOTAL_CELLS] = { 0 };
+        validMovesFor(pieceDef, cell, moves, pieces);
+        for (int c = 0; c < TOTAL_CELLS; c++) {
+            features[MOBILITY] += sign * moves[c];
+        }
+        
+        features[NEAR_STONE] += sign * proximity(ruleset, cell, STONE);
+        features[NEAR_LAVA] += sign * proximity(ruleset, cell, LAVA);
+    }
+    
+    features[SCORE_DIFFERENCE] = score[0] - score[1];
+}
+
+float evaluate(Weights weights, Ruleset ruleset, Piece pieces[TOTAL_CELLS], int score[2]) {
+    float features[FEATURE_COUNT];
+    extractFeatures(ruleset, pieces, score, features);
+    
+    float eval = 0.0f;
+    for (int i = 0; i < FEATURE_COUNT; i++) {
+        eval += weights.weights[i] * features[i];
+    }
+    return eval;
+}
+
+// Weight files
+// One "name value" line per feature. Features missing from the file keep their default
+
+Weights defaultWeights(void) {
+    Weights weights = { 0 };
+    for (int i = SIDES_3; i <= SIDES_6; i++) {
+        weights.weights[i] = 0.5f;
+    }
+    weights.weights[SCORE_DIFFERENCE] = 1.0f;
+    return weights;
+}
+
+int readWeights(Weights * weights, const char * path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return 0;
+    }
+    
+    char name[32];
+    float value;
+    while (fscanf(file, "%31s %f", name, &value) == 2) {
+        for (int i = 0; i < FEATURE_COUNT; i++) {
+            if (strcmp(name, featureNames[i]) == 0) {
+                weights->weights[i] = value;
+            }
+        }
+    }
+    
+    fclose(file);
+    return 1;
+}
+
+// Loads weights_<seed>.txt if that seed has been tuned on its own, otherwise weights.txt.
+// Returns 0 and leaves the defaults if neither exists
+int loadWeights(Weights * weights, int seed) {
+    *weights = defaultWeights();
+    
+    char path[32];
+    snprintf(path, sizeof(path), "weights_%d.txt", seed);
+    
+    return readWeights(weights, path) || readWeights(weights, "weights.txt");
+}
+
+int saveWeights(Weights weights, const char * path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return 0;
+    }
+    
+    for (int i = 0; i < FEATURE_COUNT; i++) {
+        fprintf(file, "%s %f\n", featureNames[i], weights.weights[i]);
+    }
+    
+    fclose(file);
+    return 1;
+}
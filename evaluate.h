@@ -0,0 +1,31 @@
+// Evaluating positions for bots
+// Features are always player 1's minus player 2's, so a positive evaluation is good for player 1
+
+typedef enum Feature {
+    SIDES_3, // material, one per polygon - sides go 3 to (3 + N_PIECE_DEFS - 1)
+    SIDES_4,
+    SIDES_5,
+    SIDES_6,
+    MOBILITY, // cells pieces can move to, which is where MovementDirection shows up
+    NEAR_STONE, // closeness of pieces to stone/lava cells
+    NEAR_LAVA,
+    SCORE_DIFFERENCE
+} Feature;
+#define FEATURE_COUNT 8
+
+// There's deliberately no material feature per MovementDirection. Each piece def has its own polygon, so those
+// would just add up the SIDES_ features again and the tuner couldn't tell them apart
+
+// One polygon feature per piece def, since sides go 3 to (3 + N_PIECE_DEFS - 1). Add or remove SIDES_ features to match
+_Static_assert(SIDES_6 - SIDES_3 + 1 == N_PIECE_DEFS, "need one SIDES_ feature per piece def");
+
+typedef struct Weights {
+    float weights[FEATURE_COUNT];
+} Weights;
+
+void extractFeatures(Ruleset ruleset, Piece pieces[TOTAL_CELLS], int score[2], float features[FEATURE_COUNT]);
+float evaluate(Weights weights, Ruleset ruleset, Piece pieces[TOTAL_CELLS], int score[2]);
+
+Weights defaultWeights(void);
+int loadWeights(Weights * weights, int seed);
+int saveWeights(Weights weights, const char * path);
@@ -0,0 +1,261 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "utility.h"
+#include "defs.h"
+#include "game.h"
+
+// init and generation
+
+void initBoard(Rectangle cellRecs[TOTAL_CELLS]) {
+    // Fills cellRecs data (for every rectangle)
+    for (int i = 0; i < TOTAL_CELLS; i++) {
+        cellRecs[i].x = BORDER + CELL_SIZE * (i % CELLS) + (i % CELLS);
+        cellRecs[i].y = BORDER + 1 + CELL_SIZE * (i / CELLS) + (i / CELLS);
+        cellRecs[i].width = CELL_SIZE;
+        cellRecs[i].height = CELL_SIZE;
+    }
+}
+
+void generatePieceDefs(Ruleset *ruleset) {
+    int chosenSides[ruleset->numberOfPieceDefs];
+    choose(chosenSides, ruleset->numberOfPieceDefs, N_PIECE_DEFS);
+    
+    for (int i = 0; i < ruleset->numberOfPieceDefs; i++) {
+        // could define an alternate version of choose that defines a floor, but this is fine
+        int sides = chosenSides[i] + 3; // sides in range 3-6
+        MovementDirection movementDirection = rand() % MOVEMENT_DIRECTION_COUNT;
+        
+        PieceDef pieceDef = {
+            sides,
+            movementDirection
+        };
+        ruleset->pieceDefs[i] = pieceDef;
+    }
+}
+
+void generateRules(Ruleset *ruleset) {
+    Rule rule = { 0 };
+    rule.appliesToCount = rand() % ruleset->numberOfPieceDefs + 1;
+    
+    choose(rule.appliesTo, rule.appliesToCount, ruleset->numberOfPieceDefs);
+    
+    rule.condition = (Condition) {
+        PIECE_ON_CELL_TYPE,
+        STONE
+    };
+    
+    rule.effectsCount = 2;
+    Effect effects[2] = { REMOVE_PIECE, ADD_POINT };
+    memcpy(rule.effects, effects, sizeof(effects)); // probably bad use of this, idk
+    
+   
+    ruleset->rule = rule;
+}
+
+void generateCellTypes(Ruleset *ruleset) {
+    for (int i = 0; i < TOTAL_CELLS; i++) {
+        ruleset->cellTypes[i] = NONE;
+    }
+    
+    int positions[2];
+    choose(positions, 2, HOME_CELLS);
+    
+    int position;
+    for (int i = 0; i < 2; i++) {
+        position = positions[i] + HOME_CELLS;
+        if (i % 2 == 0) {
+            ruleset->cellTypes[position] = LAVA;
+            ruleset->cellTypes[ROTATE(position)] = LAVA;
+        } else {
+            ruleset->cellTypes[position] = STONE;
+            ruleset->cellTypes[ROTATE(position)] = STONE;
+        }
+    }
+}
+
+Ruleset generateRuleset(int seed) {
+    static Color playerColors[] = {VIOLET, MAROON, DARKGREEN, PINK, PURPLE, BEIGE};
+    
+    Ruleset ruleset = {
+        seed,
+        N_PIECE_DEFS,
+        N_PIECE_DEFS * 2, // total number of pieces
+        {VIOLET, MAROON},
+        {}
+    };
+    
+    int colorIds[2];
+    choose(colorIds, 2, ARR_SIZE(playerColors));
+    
+    ruleset.playerColors[0] = playerColors[colorIds[0]];
+    ruleset.playerColors[1] = playerColors[colorIds[1]];
+       
+    generatePieceDefs(&ruleset);
+    generateRules(&ruleset);
+    generateCellTypes(&ruleset);
+    
+    
+    return ruleset;
+}
+
+void initPieces(Ruleset ruleset, Piece pieces[]) {    
+    int positions[ruleset.numberOfPieceDefs];
+    choose(positions, ruleset.numberOfPieceDefs, HOME_CELLS);
+    
+    for (int pieceDef = 0; pieceDef < ruleset.numberOfPieceDefs; pieceDef++) {
+        int position = positions[pieceDef];
+        
+        for (int player = 0; player < 2; player++) {
+            // rotate positions
+            if (player == 1) {
+                position = ROTATE(position);
+            }        
+            
+            pieces[position] = (Piece) {
+                1, // present
+                player,
+                pieceDef
+            };
+        }
+    }
+}
+
+// Logic
+int cellOnBoard(int cell) {
+    return cell >= 0 && cell < TOTAL_CELLS;
+}
+
+int movingIntoSamePlayerPiece(int from, int to, Piece pieces[TOTAL_CELLS]) {
+    return pieces[to].present && pieces[to].player == pieces[from].player;
+}
+
+
+// Assume we have max 8 valid moves
+// Doesn't care about turn - just shows possible moves for piece on owner's turn
+void validMovesFor(PieceDef pieceDef, int cell, int moves[TOTAL_CELLS], Piece pieces[TOTAL_CELLS]) {
+    switch(pieceDef.movementDirection) {
+        int target;
+        case OMNI: 
+        case ORTHOGONAL:
+            // up and down
+            target = cell - CELLS;
+            if (cellOnBoard(target) && !movingIntoSamePlayerPiece(cell, target, pieces)) moves[target] = 1;
+            
+            target = cell + CELLS;
+            if (cellOnBoard(target) && !movingIntoSamePlayerPiece(cell, target, pieces)) moves[target] = 1;
+            
+            // left and right
+            target = cell - 1;
+            if (cell % CELLS != 0 && !movingIntoSamePlayerPiece(cell, target, pieces)) moves[target] = 1;
+            
+            target = cell + 1;
+            if ((cell + 1) % CELLS != 0 && !movingIntoSamePlayerPiece(cell, target, pieces)) moves[target] = 1;
+            
+            if (pieceDef.movementDirection == ORTHOGONAL) break; // fall through if omni
+        case DIAGONAL:
+            // left-up and left-down
+            target = cell - CELLS - 1;
+            if (cell % CELLS != 0 && cellOnBoard(target) && !movingIntoSamePlayerPiece(cell, target, pieces)) moves[target] = 1;
+            
+            target = cell + CELLS - 1;
+            if (cell % CELLS != 0 && cellOnBoard(target) && !movingIntoSamePlayerPiece(cell, target, pieces)) moves[target] = 1;
+            
+            // right-up and right-down
+            target = cell - CELLS + 1;
+            if ((cell + 1) % CELLS != 0 && cellOnBoard(target) && !movingIntoSamePlayerPiece(cell, target, pieces)) moves[target] = 1;
+            
+            target = cell + CELLS + 1;
+            if ((cell + 1) % CELLS != 0 && cellOnBoard(target) && !movingIntoSamePlayerPiece(cell, target, pieces)) moves[target] = 1;
+            
+            break;
+    }
+}
+
+// Updates
+Move movePiece(int from, int to, Piece pieces[TOTAL_CELLS], Ruleset ruleset, Turn turn) {
+    Piece piece = pieces[from];
+    PieceDef pieceDef = ruleset.pieceDefs[piece.pieceDef];
+    
+    int validMoves[TOTAL_CELLS] = { 0 };
+    validMovesFor(pieceDef, from, validMoves, pieces);
+    
+    if (validMoves[to] && turn.player == piece.player) {
+        Move result = pieces[to].present ? CAPTURE : MOVE;
+        pieces[from] = (Piece) {0};
+        pieces[to] = piece;
+        return result;
+    } else {
+        return NONE; // move not valid
+    }
+}
+
+void nextTurn(Turn * turn) {
+    turn->player = turn->count % 2; // This seems like the wrong order to do it in, but we start at Turn 1, but players are represented as 0 & 1
+    turn->count = turn->count + 1;
+}
+
+// Moves the piece and applies the ruleset afterwards. This is everything that happens when a player
+// drops a piece, so the game loop and replay loading both go through here.
+// Returns the move made, and sets applies if the rule fired
+Move takeTurn(int from, int to, Piece pieces[TOTAL_CELLS], Ruleset ruleset, Turn * turn, int score[2], int * applies) {
+    // Dropped on a grid line or off the board - nothing happens
+    *applies = 0;
+    if (!cellOnBoard(from) || !cellOnBoard(to)) {
+        return NONE;
+    }
+    
+    Move move = movePiece(from, to, pieces, ruleset, *turn);
+    
+    switch(move) {
+        case CAPTURE:
+            score[turn->player] += 1;
+        case MOVE:
+            nextTurn(turn);
+        default:
+            break;
+    }
+    
+    // rules only apply after a move, even if on your next turn they still apply
+    *applies = 0;
+    for (int i = 0; i < ruleset.rule.appliesToCount; i++) {
+        if (ruleset.rule.appliesTo[i] == pieces[from].pieceDef) {
+            switch(ruleset.rule.condition.condition) {
+                case PIECE_ON_CELL_TYPE:
+                    if (ruleset.rule.condition.appliesOn == ruleset.cellTypes[to]) {
+                        *applies = 1;
+                        break;
+                    }
+                default:
+                    break;
+            }
+        }
+        
+        if (*applies == 1) {
+            break;
+        }
+    }
+    
+    if (*applies) {
+        for (int i = 0; i < ruleset.rule.effectsCount; i++) {
+            Effect effect = ruleset.rule.effects[i];
+            
+            switch (effect) {
+                case REMOVE_PIECE:
+                    pieces[to].present = 0;
+                    break;
+                case ADD_POINT:
+                    score[turn->player] += 1;
+                    break;
+                case REMOVE_POINT:
+                    score[turn->player] -= 1;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    
+    return move;
+}
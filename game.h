@@ -0,0 +1,15 @@
+// Game logic - generation, moves and rules. Nothing in here draws, so it can be used without a window
+
+// init and generation
+void initBoard(Rectangle cellRecs[TOTAL_CELLS]);
+Ruleset generateRuleset(int seed);
+void initPieces(Ruleset ruleset, Piece pieces[]);
+
+// Logic
+int cellOnBoard(int cell);
+void validMovesFor(PieceDef pieceDef, int cell, int moves[TOTAL_CELLS], Piece pieces[TOTAL_CELLS]);
+
+// Updates
+Move movePiece(int from, int to, Piece pieces[TOTAL_CELLS], Ruleset ruleset, Turn turn);
+void nextTurn(Turn * turn);
+Move takeTurn(int from, int to, Piece pieces[TOTAL_CELLS], Ruleset ruleset, Turn * turn, int score[2], int * applies);
@@ -8,197 +8,8 @@
 #include "raylib.h"
 #include "utility.h"
 #include "defs.h"
-
-// init and generation
-
-void generatePieceDefs(Ruleset *ruleset) {
-    int chosenSides[ruleset->numberOfPieceDefs];
-    choose(chosenSides, ruleset->numberOfPieceDefs, N_PIECE_DEFS);
-    
-    for (int i = 0; i < ruleset->numberOfPieceDefs; i++) {
-        // could define an alternate version of choose that defines a floor, but this is fine
-        int sides = chosenSides[i] + 3; // sides in range 3-6
-        MovementDirection movementDirection = rand() % MOVEMENT_DIRECTION_COUNT;
-        
-        PieceDef pieceDef = {
-            sides,
-            movementDirection
-        };
-        ruleset->pieceDefs[i] = pieceDef;
-    }
-}
-
-void generateRules(Ruleset *ruleset) {
-    Rule rule = { 0 };
-    rule.appliesToCount = rand() % ruleset->numberOfPieceDefs + 1;
-    
-    choose(rule.appliesTo, rule.appliesToCount, ruleset->numberOfPieceDefs);
-    
-    rule.condition = (Condition) {
-        PIECE_ON_CELL_TYPE,
-        STONE
-    };
-    
-    rule.effectsCount = 2;
-    Effect effects[2] = { REMOVE_PIECE, ADD_POINT };
-    memcpy(rule.effects, effects, sizeof(effects)); // probably bad use of this, idk
-    
-   
-    ruleset->rule = rule;
-}
-
-void generateCellTypes(Ruleset *ruleset) {
-    for (int i = 0; i < TOTAL_CELLS; i++) {
-        ruleset->cellTypes[i] = NONE;
-    }
-    
-    int positions[2];
-    choose(positions, 2, HOME_CELLS);
-    
-    int position;
-    for (int i = 0; i < 2; i++) {
-        position = positions[i] + HOME_CELLS;
-        if (i % 2 == 0) {
-            ruleset->cellTypes[position] = LAVA;
-            ruleset->cellTypes[ROTATE(position)] = LAVA;
-        } else {
-            ruleset->cellTypes[position] = STONE;
-            ruleset->cellTypes[ROTATE(position)] = STONE;
-        }
-    }
-}
-
-Ruleset generateRuleset(int seed) {
-    static Color playerColors[] = {VIOLET, MAROON, DARKGREEN, PINK, PURPLE, BEIGE};
-    
-    Ruleset ruleset = {
-        seed,
-        N_PIECE_DEFS,
-        N_PIECE_DEFS * 2, // total number of pieces
-        {VIOLET, MAROON},
-        {}
-    };
-    
-    int colorIds[2];
-    choose(colorIds, 2, ARR_SIZE(playerColors));
-    
-    ruleset.playerColors[0] = playerColors[colorIds[0]];
-    ruleset.playerColors[1] = playerColors[colorIds[1]];
-       
-    generatePieceDefs(&ruleset);
-    generateRules(&ruleset);
-    generateCellTypes(&ruleset);
-    
-    
-    return ruleset;
-}
-
-void initBoard(Rectangle cellRecs[TOTAL_CELLS]) {
-    // Fills cellRecs data (for every rectangle)
-    for (int i = 0; i < TOTAL_CELLS; i++) {
-        cellRecs[i].x = BORDER + CELL_SIZE * (i % CELLS) + (i % CELLS);
-        cellRecs[i].y = BORDER + 1 + CELL_SIZE * (i / CELLS) + (i / CELLS);
-        cellRecs[i].width = CELL_SIZE;
-        cellRecs[i].height = CELL_SIZE;
-    }
-}
-
-void initPieces(Ruleset ruleset, Piece pieces[]) {    
-    int positions[ruleset.numberOfPieceDefs];
-    choose(positions, ruleset.numberOfPieceDefs, HOME_CELLS);
-    
-    for (int pieceDef = 0; pieceDef < ruleset.numberOfPieceDefs; pieceDef++) {
-        int position = positions[pieceDef];
-        
-        for (int player = 0; player < 2; player++) {
-            // rotate positions
-            if (player == 1) {
-                position = ROTATE(position);
-            }        
-            
-            pieces[position] = (Piece) {
-                1, // present
-                player,
-                pieceDef
-            };
-        }
-    }
-}
-
-// Logic
-int cellOnBoard(int cell) {
-    return cell >= 0 && cell < TOTAL_CELLS;
-}
-
-int movingIntoSamePlayerPiece(int from, int to, Piece pieces[TOTAL_CELLS]) {
-    return pieces[to].present && pieces[to].player == pieces[from].player;
-}
-
-
-// Assume we have max 8 valid moves
-// Doesn't care about turn - just shows possible moves for piece on owner's turn
-void validMovesFor(PieceDef pieceDef, int cell, int moves[TOTAL_CELLS], Piece pieces[TOTAL_CELLS]) {
-    switch(pieceDef.movementDirection) {
-        int target;
-        case OMNI: 
-        case ORTHOGONAL:
-            // up and down
-            target = cell - CELLS;
-            if (cellOnBoard(target) && !movingIntoSamePlayerPiece(cell, target, pieces)) moves[target] = 1;
-            
-            target = cell + CELLS;
-            if (cellOnBoard(target) && !movingIntoSamePlayerPiece(cell, target, pieces)) moves[target] = 1;
-            
-            // left and right
-            target = cell - 1;
-            if (cell % CELLS != 0 && !movingIntoSamePlayerPiece(cell, target, pieces)) moves[target] = 1;
-            
-            target = cell + 1;
-            if ((cell + 1) % CELLS != 0 && !movingIntoSamePlayerPiece(cell, target, pieces)) moves[target] = 1;
-            
-            if (pieceDef.movementDirection == ORTHOGONAL) break; // fall through if omni
-        case DIAGONAL:
-            // left-up and left-down
-            target = cell - CELLS - 1;
-            if (cell % CELLS != 0 && cellOnBoard(target) && !movingIntoSamePlayerPiece(cell, target, pieces)) moves[target] = 1;
-            
-            target = cell + CELLS - 1;
-            if (cell % CELLS != 0 && cellOnBoard(target) && !movingIntoSamePlayerPiece(cell, target, pieces)) moves[target] = 1;
-            
-            // right-up and right-down
-            target = cell - CELLS + 1;
-            if ((cell + 1) % CELLS != 0 && cellOnBoard(target) && !movingIntoSamePlayerPiece(cell, target, pieces)) moves[target] = 1;
-            
-            target = cell + CELLS + 1;
-            if ((cell + 1) % CELLS != 0 && cellOnBoard(target) && !movingIntoSamePlayerPiece(cell, target, pieces)) moves[target] = 1;
-            
-            break;
-    }
-}
-
-// Updates
-Move movePiece(int from, int to, Piece pieces[TOTAL_CELLS], Ruleset ruleset, Turn turn) {
-    Piece piece = pieces[from];
-    PieceDef pieceDef = ruleset.pieceDefs[piece.pieceDef];
-    
-    int validMoves[TOTAL_CELLS] = { 0 };
-    validMovesFor(pieceDef, from, validMoves, pieces);
-    
-    if (validMoves[to] && turn.player == piece.player) {
-        Move result = pieces[to].present ? CAPTURE : MOVE;
-        pieces[from] = (Piece) {0};
-        pieces[to] = piece;
-        return result;
-    } else {
-        return NONE; // move not valid
-    }
-}
-
-void nextTurn(Turn * turn) {
-    turn->player = turn->count % 2; // This seems like the wrong order to do it in, but we start at Turn 1, but players are represented as 0 & 1
-    turn->count = turn->count + 1;
-}
-
+#include "game.h"
+#include "replay.h"
 
 // Drawing
 
@@ -452,7 +263,117 @@ Piece mouseover(MouseState * mouseState, Rectangle * cellRecs, Piece * pieces, T
 }
 
 
-int main(void) {
+// Replay
+
+void drawReplayBar(Replay replay, int speed, int playing) {
+    int y = REPLAY_BAR_Y - SIDEBAR_LINE_HEIGHT * 2;
+    
+    y = drawSidebarString("Ply %d", replay.ply, DARKBLUE, y);
+    y = drawSidebarString(playing ? "Playing x%d" : "Paused x%d", speed, DARKBLUE, y);
+    
+    DrawRectangle(SIDEBAR_INNER_X, REPLAY_BAR_Y, REPLAY_BAR_WIDTH, REPLAY_BAR_HEIGHT, DARKBLUE);
+    
+    int filled = replay.plies ? REPLAY_BAR_WIDTH * replay.ply / replay.plies : REPLAY_BAR_WIDTH;
+    DrawRectangle(SIDEBAR_INNER_X, REPLAY_BAR_Y, filled, REPLAY_BAR_HEIGHT, LIME);
+}
+
+// Controls: space play/pause, left/right step, up/down change speed, R reverse, home/end, click the bar to scrub
+int runReplay(const char * path) {
+    Replay replay;
+    if (!loadReplay(&replay, path)) {
+        printf("Couldn't load replay %s\n", path);
+        return 1;
+    }
+    
+    InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "4mb game - replay");
+    
+    Rectangle cellRecs[TOTAL_CELLS] = { 0 };
+    initBoard(cellRecs);
+    
+    Rectangle bar = { SIDEBAR_INNER_X, REPLAY_BAR_Y, REPLAY_BAR_WIDTH, REPLAY_BAR_HEIGHT };
+    
+    // Nothing is hovered or selected when watching
+    MouseState mouseState = { -1, -1, (Vector2) { 0.0f, 0.0f } };
+    
+    int playing = 0;
+    int speed = 4; // plies per second, negative plays backwards
+    float progress = 0.0f; // fraction of a ply waiting to be played
+    
+    SetTargetFPS(60);
+    
+    while (!WindowShouldClose()) {
+        // Update
+        //----------------------------------------------------------------------------------
+        
+        if (IsKeyPressed(KEY_SPACE)) playing = !playing;
+        if (IsKeyPressed(KEY_R)) speed = -speed;
+        if (IsKeyPressed(KEY_UP) && abs(speed) < REPLAY_MAX_SPEED) speed *= 2;
+        if (IsKeyPressed(KEY_DOWN) && abs(speed) > 1) speed /= 2;
+        
+        if (IsKeyPressed(KEY_RIGHT)) {
+            playing = 0;
+            seekReplay(&replay, replay.ply + 1);
+        } else if (IsKeyPressed(KEY_LEFT)) {
+            playing = 0;
+            seekReplay(&replay, replay.ply - 1);
+        } else if (IsKeyPressed(KEY_HOME)) {
+            seekReplay(&replay, 0);
+        } else if (IsKeyPressed(KEY_END)) {
+            seekReplay(&replay, replay.plies);
+        }
+        
+        Vector2 position = GetMousePosition();
+        if (IsMouseButtonDown(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec(position, bar)) {
+            playing = 0;
+            seekReplay(&replay, (int) ((position.x - bar.x) / bar.width * replay.plies + 0.5f));
+        }
+        
+        if (playing) {
+            progress += GetFrameTime() * speed;
+            
+            // Whole plies only, the rest waits for the next frame. Seeking handles big jumps at high speed
+            int plies = (int) progress;
+            progress -= plies;
+            seekReplay(&replay, replay.ply + plies);
+            
+            // Only stop at the end we're heading towards, so playing can start from either end
+            if ((speed > 0 && replay.ply == replay.plies) || (speed < 0 && replay.ply == 0)) {
+                playing = 0;
+                progress = 0.0f;
+            }
+        }
+        
+        //----------------------------------------------------------------------------------
+        
+        // Draw
+        //----------------------------------------------------------------------------------
+        BeginDrawing();
+        
+            ClearBackground(DARKBLUE);
+            
+            drawBoard(cellRecs, replay.state.pieces, replay.ruleset, mouseState, replay.state.turn);
+            
+            drawSidebar(replay.ruleset, replay.state.score, replay.state.turn, 0);
+            
+            drawReplayBar(replay, speed, playing);
+        
+        EndDrawing();
+        //----------------------------------------------------------------------------------
+    }
+    
+    CloseWindow();
+    freeReplay(&replay);
+    
+    return 0;
+}
+
+
+int main(int argc, char * argv[]) {
+    // Passing a recorded game watches it instead of starting a new one
+    if (argc > 1) {
+        return runReplay(argv[1]);
+    }
+    
     // Initialization
     //--------------------------------------------------------------------------------------
 
@@ -481,6 +402,8 @@ int main(void) {
     
     Turn turn = { 1, 0 };
     
+    Recording recording = newRecording(SEED);
+    
     MouseState mouseState = { -1, -1, (Vector2) { 0.0f, 0.0f } };
     
     Piece mousePiece;
@@ -505,56 +428,12 @@ int main(void) {
         if (mouseState.selectedPiece == -1 && IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && mousePiece.present && mousePiece.player == turn.player) {
             mouseState.selectedPiece = mouseState.cell;
         } else if (mouseState.selectedPiece != -1 && IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
-            Move move = movePiece(mouseState.selectedPiece, mouseState.cell, pieces, ruleset, turn);
-            
-            switch(move) {
-                case CAPTURE:
-                    score[turn.player] += 1;
-                case MOVE:
-                    nextTurn(&turn);
-                default:
-                    break;
-            }
-            
-            // rules only apply after a move, even if on your next turn they still apply
-            applies = 0;
-            for (int i = 0; i < ruleset.rule.appliesToCount; i++) {
-                if (ruleset.rule.appliesTo[i] == pieces[mouseState.selectedPiece].pieceDef) {
-                    switch(ruleset.rule.condition.condition) {
-                        case PIECE_ON_CELL_TYPE:
-                            if (ruleset.rule.condition.appliesOn == ruleset.cellTypes[mouseState.cell]) {
-                                printf("rule applies to %d", i);
-                                applies = 1;
-                                break;
-                            }
-                        default:
-                            break;
-                    }
-                }
-                
-                if (applies == 1) {
-                    break;
-                }
-            }
+            int from = mouseState.selectedPiece;
+            int to = mouseState.cell;
+            Move move = takeTurn(from, to, pieces, ruleset, &turn, score, &applies);
             
-            if (applies) {
-                for (int i = 0; i < ruleset.rule.effectsCount; i++) {
-                    Effect effect = ruleset.rule.effects[i];
-                    
-                    switch (effect) {
-                        case REMOVE_PIECE:
-                            pieces[mouseState.cell].present = 0;
-                            break;
-                        case ADD_POINT:
-                            score[turn.player] += 1;
-                            break;
-                        case REMOVE_POINT:
-                            score[turn.player] -= 1;
-                            break;
-                        default:
-                            break;
-                    }
-                }
+            if (move != NONE || applies) {
+                recordAction(&recording, from, to);
             }
             
             mouseState.selectedPiece = -1;
@@ -581,6 +460,16 @@ int main(void) {
     //--------------------------------------------------------------------------------------
     CloseWindow();        // Close window and OpenGL context
     //--------------------------------------------------------------------------------------
+    
+    // Keep the game so it can be watched back with ./game replay_<seed>.txt
+    if (recording.count > 0) {
+        char path[32];
+        snprintf(path, sizeof(path), "replay_%d.txt", SEED);
+        if (saveRecording(recording, path)) {
+            printf("Saved replay to %s\n", path);
+        }
+    }
+    freeRecording(&recording);
 
     return 0;
 }
\ No newline at end of file
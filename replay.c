@@ -0,0 +1,167 @@
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "raylib.h"
+#include "defs.h"
+#include "game.h"
+#include "replay.h"
+
+// Recording
+// A recording is just the seed and what the players did. Everything else can be rebuilt from that,
+// since the ruleset and starting pieces only depend on the seed
+
+Recording newRecording(int seed) {
+    return (Recording) { seed, 0, 0, NULL };
+}
+
+void recordAction(Recording * recording, int from, int to) {
+    if (recording->count == recording->capacity) {
+        recording->capacity = recording->capacity ? recording->capacity * 2 : 64;
+        recording->actions = (Action*)realloc(recording->actions, recording->capacity * sizeof(Action));
+    }
+
+    recording->actions[recording->count] = (Action) { from, to };
+    recording->count++;
+}
+
+// Returns 1 if the file was written
+int saveRecording(Recording recording, const char * path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return 0;
+    }
+
+    fprintf(file, "seed %d\n", recording.seed);
+    for (int i = 0; i < recording.count; i++) {
+        fprintf(file, "%d %d\n", recording.actions[i].from, recording.actions[i].to);
+    }
+
+    fclose(file);
+    return 1;
+}
+
+void freeRecording(Recording * recording) {
+    free(recording->actions);
+    *recording = (Recording) { 0 };
+}
+
+// Replay
+// Loading plays the whole game through once, keeping a delta for every ply and a full snapshot every
+// KEYFRAME_INTERVAL plies. Seeking then never has to apply more than KEYFRAME_INTERVAL deltas,
+// however long the game is
+
+void stepForward(Replay * replay) {
+    PlyDelta delta = replay->deltas[replay->ply];
+
+    replay->state.pieces[delta.from] = delta.after[0];
+    replay->state.pieces[delta.to] = delta.after[1];
+    replay->state.score[0] = delta.scoreAfter[0];
+    replay->state.score[1] = delta.scoreAfter[1];
+    replay->state.turn = delta.turnAfter;
+    replay->ply++;
+}
+
+void stepBackward(Replay * replay) {
+    replay->ply--;
+    PlyDelta delta = replay->deltas[replay->ply];
+
+    // undo in reverse order, in case from and to are the same cell
+    replay->state.pieces[delta.to] = delta.before[1];
+    replay->state.pieces[delta.from] = delta.before[0];
+    replay->state.score[0] = delta.scoreBefore[0];
+    replay->state.score[1] = delta.scoreBefore[1];
+    replay->state.turn = delta.turnBefore;
+}
+
+// Returns 1 if the replay was loaded
+int loadReplay(Replay * replay, const char * path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return 0;
+    }
+
+    int seed;
+    if (fscanf(file, "seed %d", &seed) != 1) {
+        fclose(file);
+        return 0;
+    }
+
+    Recording recording = newRecording(seed);
+    int from, to;
+    while (fscanf(file, "%d %d", &from, &to) == 2) {
+        if (cellOnBoard(from) && cellOnBoard(to)) {
+            recordAction(&recording, from, to);
+        }
+    }
+    fclose(file);
+
+    // Same order as starting a game, so rand() gives the same ruleset and pieces
+    srand(seed);
+    *replay = (Replay) { 0 };
+    replay->ruleset = generateRuleset(seed);
+
+    GameState state = { 0 };
+    initPieces(replay->ruleset, state.pieces);
+    state.turn = (Turn) { 1, 0 };
+
+    replay->plies = recording.count;
+    replay->deltas = (PlyDelta*)malloc((recording.count + 1) * sizeof(PlyDelta));
+    replay->keyframes = (GameState*)malloc((recording.count / KEYFRAME_INTERVAL + 1) * sizeof(GameState));
+
+    for (int ply = 0; ply <= recording.count; ply++) {
+        if (ply % KEYFRAME_INTERVAL == 0) {
+            replay->keyframes[ply / KEYFRAME_INTERVAL] = state;
+        }
+
+        if (ply == recording.count) {
+            break;
+        }
+
+        Action action = recording.actions[ply];
+        PlyDelta delta = { action.from, action.to };
+
+        delta.before[0] = state.pieces[action.from];
+        delta.before[1] = state.pieces[action.to];
+        delta.scoreBefore[0] = state.score[0];
+        delta.scoreBefore[1] = state.score[1];
+        delta.turnBefore = state.turn;
+
+        int applies;
+        takeTurn(action.from, action.to, state.pieces, replay->ruleset, &state.turn, state.score, &applies);
+
+        delta.after[0] = state.pieces[action.from];
+        delta.after[1] = state.pieces[action.to];
+        delta.scoreAfter[0] = state.score[0];
+        delta.scoreAfter[1] = state.score[1];
+        delta.turnAfter = state.turn;
+
+        replay->deltas[ply] = delta;
+    }
+
+    freeRecording(&recording);
+
+    replay->ply = 0;
+    replay->state = replay->keyframes[0];
+    return 1;
+}
+
+void seekReplay(Replay * replay, int ply) {
+    if (ply < 0) ply = 0;
+    if (ply > replay->plies) ply = replay->plies;
+
+    // Close by, just walk there. Otherwise jump to the keyframe at or before ply and walk forward from that
+    if (abs(ply - replay->ply) > KEYFRAME_INTERVAL) {
+        int keyframe = ply / KEYFRAME_INTERVAL;
+        replay->state = replay->keyframes[keyframe];
+        replay->ply = keyframe * KEYFRAME_INTERVAL;
+    }
+
+    while (replay->ply < ply) stepForward(replay);
+    while (replay->ply > ply) stepBackward(replay);
+}
+
+void freeReplay(Replay * replay) {
+    free(replay->deltas);
+    free(replay->keyframes);
+    *replay = (Replay) { 0 };
+}
@@ -0,0 +1,54 @@
+// Recording and replaying games
+
+// Everything that changes as a game goes on - the ruleset stays fixed for the whole game
+typedef struct GameState {
+    Piece pieces[TOTAL_CELLS];
+    int score[2];
+    Turn turn;
+} GameState;
+
+// What the player did - dropped the piece on from onto to
+typedef struct Action {
+    int from;
+    int to;
+} Action;
+
+typedef struct Recording {
+    int seed;
+    int count;
+    int capacity;
+    Action * actions;
+} Recording;
+
+// Change made by one ply. A turn only ever touches the from and to cells, so storing both sides
+// of those lets us step forwards and backwards without re-running the rules
+typedef struct PlyDelta {
+    int from;
+    int to;
+    Piece before[2]; // from, to
+    Piece after[2];
+    int scoreBefore[2];
+    int scoreAfter[2];
+    Turn turnBefore;
+    Turn turnAfter;
+} PlyDelta;
+
+typedef struct Replay {
+    Ruleset ruleset;
+    int plies;
+    PlyDelta * deltas; // deltas[i] takes ply i to ply i + 1
+    GameState * keyframes; // keyframes[k] is the state at ply k * KEYFRAME_INTERVAL
+    int ply; // ply currently shown
+    GameState state; // state at ply
+} Replay;
+
+// Recording
+Recording newRecording(int seed);
+void recordAction(Recording * recording, int from, int to);
+int saveRecording(Recording recording, const char * path);
+void freeRecording(Recording * recording);
+
+// Replay
+int loadReplay(Replay * replay, const char * path);
+void seekReplay(Replay * replay, int ply);
+void freeReplay(Replay * replay);
@@ -0,0 +1,360 @@
+// Headless board thumbnails for every seed, for the seed browser
+// Draws the same board as drawGrid/drawPiece, but on the CPU into a pixel buffer, so no window or GPU is needed.
+// raylib.h is only used for the types and colours, so this doesn't link against raylib:
+//     cc -O2 thumbnails.c game.c utility.c -o thumbnails -lpthread -lm
+//     ./thumbnails <outdir> [first seed] [last seed] [scale] [threads] [png|ppm]
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include "raylib.h"
+#include "defs.h"
+#include "game.h"
+
+#define THUMBNAIL_SIZE (BOARD_BOUNDARY + BORDER) // board plus border on both sides, before scaling
+#define MAX_SEED 9999 // main picks seeds from time(0) % 10000
+#define MAX_THREADS 256
+
+typedef struct Canvas {
+    int width;
+    int height;
+    float scale; // canvas pixels per window pixel
+    unsigned char *pixels; // RGB
+} Canvas;
+
+typedef struct Job {
+    const char *outdir;
+    int nextSeed;
+    int lastSeed;
+    float scale;
+    int png;
+    int failed;
+    pthread_mutex_t lock;
+} Job;
+
+// Rasterising
+// Coordinates are in window pixels like the raylib calls, and get scaled on the way in
+
+void fillRect(Canvas *canvas, float x, float y, float width, float height, Color color) {
+    int x0 = (int) (x * canvas->scale);
+    int y0 = (int) (y * canvas->scale);
+    int x1 = (int) ceilf((x + width) * canvas->scale);
+    int y1 = (int) ceilf((y + height) * canvas->scale);
+
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > canvas->width) x1 = canvas->width;
+    if (y1 > canvas->height) y1 = canvas->height;
+
+    for (int py = y0; py < y1; py++) {
+        unsigned char *pixel = canvas->pixels + (py * canvas->width + x0) * 3;
+        for (int px = x0; px < x1; px++) {
+            pixel[0] = color.r;
+            pixel[1] = color.g;
+            pixel[2] = color.b;
+            pixel += 3;
+        }
+    }
+}
+
+// Same vertices as DrawPoly before raylib 4.2, which the game is drawn with (drawArrowV's arrowheads rely on it):
+// vertex i sits at (sin, cos) of 360 * i / sides degrees, turned by rotation
+void fillPoly(Canvas *canvas, Vector2 center, int sides, float radius, float rotation, Color color) {
+    float cx = center.x * canvas->scale;
+    float cy = center.y * canvas->scale;
+    float r = radius * canvas->scale;
+
+    Vector2 vertices[8];
+    for (int i = 0; i < sides; i++) {
+        float angle = (360.0f * i / sides - rotation) * DEG2RAD;
+        vertices[i] = (Vector2) { cx + sinf(angle) * r, cy + cosf(angle) * r };
+    }
+
+    int x0 = (int) (cx - r), x1 = (int) ceilf(cx + r);
+    int y0 = (int) (cy - r), y1 = (int) ceilf(cy + r);
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > canvas->width) x1 = canvas->width;
+    if (y1 > canvas->height) y1 = canvas->height;
+
+    for (int py = y0; py < y1; py++) {
+        for (int px = x0; px < x1; px++) {
+            // Pixel centre is inside a convex polygon if it's on the same side of every edge
+            float x = px + 0.5f, y = py + 0.5f;
+            int positive = 0, negative = 0;
+            for (int i = 0; i < sides; i++) {
+                Vector2 a = vertices[i];
+                Vector2 b = vertices[(i + 1) % sides];
+                float cross = (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+                if (cross > 0) positive = 1;
+                if (cross < 0) negative = 1;
+            }
+
+            if (!(positive && negative)) {
+                unsigned char *pixel = canvas->pixels + (py * canvas->width + px) * 3;
+                pixel[0] = color.r;
+                pixel[1] = color.g;
+                pixel[2] = color.b;
+            }
+        }
+    }
+}
+
+// Mirrors drawGrid and drawPiece in main.c
+void renderBoard(Canvas *canvas, Ruleset ruleset, Rectangle cellRecs[TOTAL_CELLS], Piece pieces[TOTAL_CELLS]) {
+    fillRect(canvas, 0, 0, THUMBNAIL_SIZE, THUMBNAIL_SIZE, DARKBLUE);
+
+    for (int i = 0; i < TOTAL_CELLS; i++) {
+        Rectangle rec = cellRecs[i];
+
+        switch(ruleset.cellTypes[i]) {
+            case STONE:
+                fillRect(canvas, rec.x, rec.y, rec.width, rec.height, GRAY);
+                break;
+            case LAVA:
+                fillRect(canvas, rec.x, rec.y, rec.width, rec.height, RED);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Lines are one pixel wide in the window, so keep at least one pixel when scaled down
+    float line = canvas->scale < 1 ? 1 / canvas->scale : 1;
+    for (int i = BORDER; i <= BOARD_BOUNDARY; i += CELL_SIZE + 1) {
+        fillRect(canvas, i, BORDER, line, BOARD_BOUNDARY - BORDER, SKYBLUE);
+        fillRect(canvas, BORDER, i, BOARD_BOUNDARY - 1 - BORDER, line, SKYBLUE);
+    }
+
+    for (int cell = 0; cell < TOTAL_CELLS; cell++) {
+        Piece piece = pieces[cell];
+        if (!piece.present) continue;
+
+        Vector2 center = { cellRecs[cell].x + HALF_CELL_SIZE, cellRecs[cell].y + HALF_CELL_SIZE };
+        PieceDef pieceDef = ruleset.pieceDefs[piece.pieceDef];
+        int radius = PIECE_RADIUS;
+        int angle = 180 * piece.player;
+
+        fillPoly(canvas, center, pieceDef.sides, radius * 1.1, angle, BLACK);
+        fillPoly(canvas, center, pieceDef.sides, radius, angle, ruleset.playerColors[piece.player]);
+    }
+}
+
+// Writing
+
+int writePPM(Canvas *canvas, const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return 0;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", canvas->width, canvas->height);
+    fwrite(canvas->pixels, 3, canvas->width * canvas->height, file);
+
+    fclose(file);
+    return 1;
+}
+
+unsigned int crcTable[256];
+
+void initCrcTable(void) {
+    for (unsigned int n = 0; n < 256; n++) {
+        unsigned int c = n;
+        for (int k = 0; k < 8; k++) {
+            c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        }
+        crcTable[n] = c;
+    }
+}
+
+unsigned int crc(unsigned int c, const unsigned char *data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        c = crcTable[(c ^ data[i]) & 0xff] ^ (c >> 8);
+    }
+    return c;
+}
+
+void putBigEndian(unsigned char *out, unsigned int n) {
+    out[0] = n >> 24;
+    out[1] = n >> 16;
+    out[2] = n >> 8;
+    out[3] = n;
+}
+
+void writeChunk(FILE *file, const char *type, const unsigned char *data, unsigned int length) {
+    unsigned char header[8];
+    putBigEndian(header, length);
+    memcpy(header + 4, type, 4);
+    fwrite(header, 1, 8, file);
+    fwrite(data, 1, length, file);
+
+    unsigned int c = crc(0xffffffffu, header + 4, 4);
+    c = crc(c, data, length) ^ 0xffffffffu;
+    unsigned char footer[4];
+    putBigEndian(footer, c);
+    fwrite(footer, 1, 4, file);
+}
+
+// Uncompressed PNG - zlib stream made of stored deflate blocks, so we don't need zlib
+int writePNG(Canvas *canvas, const char *path) {
+    size_t rowLength = canvas->width * 3 + 1; // filter byte then RGB
+    size_t rawLength = rowLength * canvas->height;
+    size_t blocks = rawLength / 65535 + 1;
+    size_t idatLength = 2 + rawLength + blocks * 5 + 4;
+
+    unsigned char *idat = (unsigned char*)malloc(idatLength);
+    unsigned char *out = idat;
+    *out++ = 0x78; // zlib header, no compression
+    *out++ = 0x01;
+
+    unsigned int a = 1, b = 0; // adler32
+    size_t remaining = rawLength;
+    size_t offset = 0;
+    while (remaining > 0 || out == idat + 2) {
+        unsigned int length = remaining > 65535 ? 65535 : remaining;
+        remaining -= length;
+
+        *out++ = remaining == 0; // final block flag
+        *out++ = length & 0xff;
+        *out++ = length >> 8;
+        *out++ = ~length & 0xff;
+        *out++ = (~length >> 8) & 0xff;
+
+        for (unsigned int i = 0; i < length; i++, offset++) {
+            size_t column = offset % rowLength;
+            unsigned char byte = column == 0 ? 0 : canvas->pixels[(offset / rowLength) * (rowLength - 1) + column - 1];
+            *out++ = byte;
+            a = (a + byte) % 65521;
+            b = (b + a) % 65521;
+        }
+    }
+    putBigEndian(out, (b << 16) | a);
+    out += 4;
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        free(idat);
+        return 0;
+    }
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    fwrite(signature, 1, 8, file);
+
+    unsigned char ihdr[13] = { 0 };
+    putBigEndian(ihdr, canvas->width);
+    putBigEndian(ihdr + 4, canvas->height);
+    ihdr[8] = 8; // bit depth
+    ihdr[9] = 2; // truecolour RGB
+    writeChunk(file, "IHDR", ihdr, 13);
+    writeChunk(file, "IDAT", idat, out - idat);
+    writeChunk(file, "IEND", NULL, 0);
+
+    fclose(file);
+    free(idat);
+    return 1;
+}
+
+// Workers
+
+void *thumbnailWorker(void *arg) {
+    Job *job = (Job*)arg;
+
+    Canvas canvas = { 0 };
+    canvas.scale = job->scale;
+    canvas.width = (int) ceilf(THUMBNAIL_SIZE * job->scale);
+    canvas.height = canvas.width;
+    canvas.pixels = (unsigned char*)malloc(canvas.width * canvas.height * 3);
+
+    Rectangle cellRecs[TOTAL_CELLS] = { 0 };
+    initBoard(cellRecs);
+
+    for (;;) {
+        Ruleset ruleset;
+        Piece pieces[TOTAL_CELLS] = { 0 };
+
+        // Generation goes through rand(), which is shared, so only one thread can build a board at once.
+        // It's cheap next to rasterising, which happens outside the lock
+        pthread_mutex_lock(&job->lock);
+        int seed = job->nextSeed++;
+        if (seed <= job->lastSeed) {
+            srand(seed);
+            ruleset = generateRuleset(seed);
+            initPieces(ruleset, pieces);
+        }
+        pthread_mutex_unlock(&job->lock);
+
+        if (seed > job->lastSeed) break;
+
+        renderBoard(&canvas, ruleset, cellRecs, pieces);
+
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/seed_%04d.%s", job->outdir, seed, job->png ? "png" : "ppm");
+        int written = job->png ? writePNG(&canvas, path) : writePPM(&canvas, path);
+
+        if (!written) {
+            pthread_mutex_lock(&job->lock);
+            printf("Couldn't write %s\n", path);
+            job->failed++;
+            pthread_mutex_unlock(&job->lock);
+        }
+    }
+
+    free(canvas.pixels);
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        printf("Usage: %s <outdir> [first seed] [last seed] [scale] [threads] [png|ppm]\n", argv[0]);
+        return 1;
+    }
+
+    Job job = { 0 };
+    job.outdir = argv[1];
+    job.nextSeed = argc > 2 ? atoi(argv[2]) : 0;
+    job.lastSeed = argc > 3 ? atoi(argv[3]) : MAX_SEED;
+    job.scale = argc > 4 ? atof(argv[4]) : 0.25f;
+    int threads = argc > 5 ? atoi(argv[5]) : (int) sysconf(_SC_NPROCESSORS_ONLN);
+    job.png = argc > 6 ? strcmp(argv[6], "ppm") != 0 : 1;
+    pthread_mutex_init(&job.lock, NULL);
+
+    if (job.scale <= 0) job.scale = 0.25f;
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+
+    // Make the output directory if needed, so a bad path fails here rather than once per seed
+    struct stat info;
+    if ((mkdir(job.outdir, 0755) != 0 && errno != EEXIST) || stat(job.outdir, &info) != 0 || !S_ISDIR(info.st_mode)) {
+        printf("Couldn't use output directory %s\n", job.outdir);
+        return 1;
+    }
+
+    initCrcTable();
+
+    // Workers just pull seeds until there are none left, so running with fewer than asked for is fine
+    pthread_t workers[MAX_THREADS];
+    int started = 0;
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&workers[started], NULL, thumbnailWorker, &job) == 0) {
+            started++;
+        }
+    }
+
+    if (started == 0) {
+        printf("Couldn't start any threads, rendering on this one\n");
+        thumbnailWorker(&job);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    pthread_mutex_destroy(&job.lock);
+
+    return job.failed ? 1 : 0;
+}
@@ -0,0 +1,288 @@
+// Fits evaluation weights to recorded games, for the bots to load with loadWeights
+// Every position in every replay is labelled with how that game ended, then the weights are fitted by gradient
+// descent on the logistic loss of sigmoid(evaluation) against the result. The loss is convex and the features are
+// scaled first, so starting from zero weights the defaults (rate 2, 500 iterations) reach the minimum in a few
+// hundred iterations - the loss printed at the end should have stopped changing. Doesn't need a window:
+//     cc -O2 tuner.c evaluate.c replay.c game.c utility.c -o tuner -lpthread -lm
+//     ./tuner [-s seed] [-t threads] [-i iterations] [-r rate] [-o weights file] replay_*.txt
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "raylib.h"
+#include "defs.h"
+#include "replay.h"
+#include "evaluate.h"
+
+#define MAX_THREADS 256
+
+typedef struct Corpus {
+    int count;
+    int capacity;
+    float *features; // FEATURE_COUNT per position
+    float *results; // 1 player 1 won, 0 player 2 won, 0.5 draw
+} Corpus;
+
+typedef struct Tuner {
+    Corpus corpus;
+    Weights weights;
+    int threads;
+    int iterations;
+    float rate;
+    double (*gradients)[FEATURE_COUNT + 1]; // one row per thread, loss in the last column
+    pthread_barrier_t barrier;
+    pthread_mutex_t start; // held until we know how many threads actually started
+} Tuner;
+
+typedef struct Worker {
+    Tuner *tuner;
+    int id;
+} Worker;
+
+// Corpus
+
+void addPosition(Corpus *corpus, float features[FEATURE_COUNT], float result) {
+    if (corpus->count == corpus->capacity) {
+        corpus->capacity = corpus->capacity ? corpus->capacity * 2 : 4096;
+        corpus->features = (float*)realloc(corpus->features, (size_t) corpus->capacity * FEATURE_COUNT * sizeof(float));
+        corpus->results = (float*)realloc(corpus->results, (size_t) corpus->capacity * sizeof(float));
+    }
+
+    memcpy(corpus->features + (size_t) corpus->count * FEATURE_COUNT, features, FEATURE_COUNT * sizeof(float));
+    corpus->results[corpus->count] = result;
+    corpus->count++;
+}
+
+// Adds every position from the replay. seed -1 takes any seed, otherwise other seeds are skipped
+int addReplay(Corpus *corpus, const char *path, int seed) {
+    Replay replay;
+    if (!loadReplay(&replay, path)) {
+        return 0;
+    }
+
+    if (seed == -1 || replay.ruleset.seed == seed) {
+        seekReplay(&replay, replay.plies);
+        int *final = replay.state.score;
+        float result = final[0] > final[1] ? 1.0f : final[0] < final[1] ? 0.0f : 0.5f;
+
+        // Stepping one ply at a time only ever applies a single delta
+        for (int ply = 0; ply <= replay.plies; ply++) {
+            seekReplay(&replay, ply);
+
+            float features[FEATURE_COUNT];
+            extractFeatures(replay.ruleset, replay.state.pieces, replay.state.score, features);
+            addPosition(corpus, features, result);
+        }
+    }
+
+    freeReplay(&replay);
+    return 1;
+}
+
+// Scaling
+// Score difference is unbounded while the rest are small counts, so one step size can't suit them all. Each feature
+// is divided by its RMS over the corpus before fitting, and the weights are scaled back afterwards. The features are
+// all differences between the players, so there's no mean to take off
+
+void scaleFeatures(Corpus *corpus, float scale[FEATURE_COUNT]) {
+    double squares[FEATURE_COUNT] = { 0 };
+    for (size_t i = 0; i < (size_t) corpus->count * FEATURE_COUNT; i++) {
+        squares[i % FEATURE_COUNT] += corpus->features[i] * corpus->features[i];
+    }
+
+    for (int f = 0; f < FEATURE_COUNT; f++) {
+        float rms = sqrt(squares[f] / corpus->count);
+        scale[f] = rms > 0 ? rms : 1.0f; // never seen, leave it alone
+    }
+
+    for (size_t i = 0; i < (size_t) corpus->count * FEATURE_COUNT; i++) {
+        corpus->features[i] /= scale[i % FEATURE_COUNT];
+    }
+}
+
+// Fitting
+// Each thread sums the gradient over its own slice of the corpus, then thread 0 adds them up and steps the weights.
+// The barriers keep everyone on the same iteration
+
+void *tunerWorker(void *arg) {
+    Worker *worker = (Worker*)arg;
+    Tuner *tuner = worker->tuner;
+    Corpus *corpus = &tuner->corpus;
+
+    // threads and the barrier aren't final until every thread has been created
+    pthread_mutex_lock(&tuner->start);
+    pthread_mutex_unlock(&tuner->start);
+
+    int start = (int) ((long long) corpus->count * worker->id / tuner->threads);
+    int end = (int) ((long long) corpus->count * (worker->id + 1) / tuner->threads);
+
+    for (int iteration = 0; iteration < tuner->iterations; iteration++) {
+        double gradient[FEATURE_COUNT + 1] = { 0 };
+        float *weights = tuner->weights.weights;
+
+        for (int i = start; i < end; i++) {
+            float *features = corpus->features + (size_t) i * FEATURE_COUNT;
+
+            float eval = 0.0f;
+            for (int f = 0; f < FEATURE_COUNT; f++) {
+                eval += weights[f] * features[f];
+            }
+
+            float predicted = 1.0f / (1.0f + expf(-eval));
+            float error = predicted - corpus->results[i];
+            for (int f = 0; f < FEATURE_COUNT; f++) {
+                gradient[f] += error * features[f];
+            }
+
+            // clamped so a confident wrong guess doesn't take the log of 0
+            float p = fminf(fmaxf(predicted, 1e-6f), 1 - 1e-6f);
+            gradient[FEATURE_COUNT] -= corpus->results[i] * logf(p) + (1 - corpus->results[i]) * logf(1 - p);
+        }
+
+        memcpy(tuner->gradients[worker->id], gradient, sizeof(gradient));
+        pthread_barrier_wait(&tuner->barrier);
+
+        if (worker->id == 0) {
+            double total[FEATURE_COUNT + 1] = { 0 };
+            for (int t = 0; t < tuner->threads; t++) {
+                for (int f = 0; f <= FEATURE_COUNT; f++) {
+                    total[f] += tuner->gradients[t][f];
+                }
+            }
+
+            for (int f = 0; f < FEATURE_COUNT; f++) {
+                tuner->weights.weights[f] -= tuner->rate * total[f] / corpus->count;
+            }
+
+            if (iteration % 100 == 0 || iteration == tuner->iterations - 1) {
+                printf("iteration %d loss %f\n", iteration, total[FEATURE_COUNT] / corpus->count);
+            }
+        }
+        pthread_barrier_wait(&tuner->barrier);
+    }
+
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    Tuner tuner = { 0 };
+    tuner.weights = (Weights) { 0 };
+    tuner.threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    tuner.iterations = 500;
+    tuner.rate = 2.0f;
+
+    int seed = -1;
+    const char *out = NULL;
+
+    int arg = 1;
+    for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+        switch(argv[arg][1]) {
+            case 's':
+                seed = atoi(argv[arg + 1]);
+                break;
+            case 't':
+                tuner.threads = atoi(argv[arg + 1]);
+                break;
+            case 'i':
+                tuner.iterations = atoi(argv[arg + 1]);
+                break;
+            case 'r':
+                tuner.rate = atof(argv[arg + 1]);
+                break;
+            case 'o':
+                out = argv[arg + 1];
+                break;
+            default:
+                printf("Unknown option %s\n", argv[arg]);
+                return 1;
+        }
+    }
+
+    if (arg >= argc) {
+        printf("Usage: %s [-s seed] [-t threads] [-i iterations] [-r rate] [-o weights file] <replay files...>\n", argv[0]);
+        return 1;
+    }
+
+    for (; arg < argc; arg++) {
+        if (!addReplay(&tuner.corpus, argv[arg], seed)) {
+            printf("Couldn't load replay %s\n", argv[arg]);
+        }
+    }
+
+    if (tuner.corpus.count == 0) {
+        printf("No positions to tune on\n");
+        return 1;
+    }
+    printf("Tuning on %d positions\n", tuner.corpus.count);
+
+    float scale[FEATURE_COUNT];
+    scaleFeatures(&tuner.corpus, scale);
+    for (int f = 0; f < FEATURE_COUNT; f++) {
+        tuner.weights.weights[f] *= scale[f];
+    }
+
+    if (tuner.threads < 1) tuner.threads = 1;
+    if (tuner.threads > MAX_THREADS) tuner.threads = MAX_THREADS;
+    tuner.gradients = malloc(tuner.threads * sizeof(*tuner.gradients));
+
+    // The corpus is split between however many threads start, so hold them back until that's known
+    pthread_t threads[MAX_THREADS];
+    Worker workers[MAX_THREADS];
+    int started = 0;
+    pthread_mutex_init(&tuner.start, NULL);
+    pthread_mutex_lock(&tuner.start);
+    for (int i = 0; i < tuner.threads; i++) {
+        workers[started] = (Worker) { &tuner, started };
+        if (pthread_create(&threads[started], NULL, tunerWorker, &workers[started]) == 0) {
+            started++;
+        }
+    }
+
+    if (started < tuner.threads) {
+        printf("Only started %d of %d threads\n", started, tuner.threads);
+    }
+    tuner.threads = started ? started : 1;
+    pthread_barrier_init(&tuner.barrier, NULL, tuner.threads);
+    pthread_mutex_unlock(&tuner.start);
+
+    if (started == 0) {
+        tunerWorker(&workers[0]);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_barrier_destroy(&tuner.barrier);
+    pthread_mutex_destroy(&tuner.start);
+
+    for (int f = 0; f < FEATURE_COUNT; f++) {
+        tuner.weights.weights[f] /= scale[f];
+    }
+
+    // Same names loadWeights looks for
+    char path[32];
+    if (!out) {
+        if (seed == -1) {
+            snprintf(path, sizeof(path), "weights.txt");
+        } else {
+            snprintf(path, sizeof(path), "weights_%d.txt", seed);
+        }
+        out = path;
+    }
+
+    if (!saveWeights(tuner.weights, out)) {
+        printf("Couldn't write %s\n", out);
+        return 1;
+    }
+    printf("Saved weights to %s\n", out);
+
+    free(tuner.gradients);
+    free(tuner.corpus.features);
+    free(tuner.corpus.results);
+
+    return 0;
+}